@@ -19,6 +19,17 @@ namespace
 	}
 
 	CRY_STATIC_AUTO_REGISTER_FUNCTION(&RegisterPlayerComponent);
+
+	// Conversions between the engine's vectors and the ones used by the simulation.
+	Vec3 ToVec3(const SPlayerSimulationVec3& v)
+	{
+		return Vec3(v.x, v.y, v.z);
+	}
+
+	SPlayerSimulationVec3 ToSimulationVec3(const Vec3& v)
+	{
+		return { v.x, v.y, v.z };
+	}
 }
 
 void CPlayerComponent::Initialize()
@@ -121,6 +132,8 @@ void CPlayerComponent::InitializePlayer()
 	m_pInputComponent->BindAction("player", "shoot", eAID_KeyboardMouse, EKeyId::eKI_Mouse1);
 	// Spawn the cursor
 	SpawnCursorEntity();
+	// Start simulating from wherever the player was spawned.
+	ResetSimulation();
 }
 
 // Processing which Event flags we need.
@@ -211,32 +224,24 @@ void CPlayerComponent::SpawnCursorEntity()
 
 void CPlayerComponent::UpdateMovementRequest(float frameTime)
 {
-	// Don't handle input if we are in air
-	if (!m_pCharacterController->IsOnGround())
-		return;
-	// initialize our velocity variable to be a zero vector
-	Vec3 velocity = ZERO;
-	// create a move speed float value, 20.5 is a smooth movement speed.
-	const float moveSpeed = 20.5f;
-	// Utilizing our input flags, we can manipulate how the player moves.
-	if (m_inputFlags & EInputFlag::MoveLeft)
-	{
-		velocity.x -= moveSpeed * frameTime;
-	}
-	if (m_inputFlags & EInputFlag::MoveRight)
-	{
-		velocity.x += moveSpeed * frameTime;
-	}
-	if (m_inputFlags & EInputFlag::MoveForward)
-	{
-		velocity.y += moveSpeed * frameTime;
-	}
-	if (m_inputFlags & EInputFlag::MoveBack)
+	// Complete the input for this tick, the cursor position was already stored as it changed.
+	m_simulationInput.frameTime = frameTime;
+	m_simulationInput.moveFlags = m_inputFlags.UnderlyingValue();
+	m_simulationInput.isOnGround = m_pCharacterController->IsOnGround() ? 1 : 0;
+	// Record how far physics moved the player away from what we predicted last tick.
+	m_simulationInput.positionCorrection = ToSimulationVec3(m_pEntity->GetWorldPos() - ToVec3(m_simulationState.position));
+	m_simulationInput.velocityCorrection = ToSimulationVec3(m_pCharacterController->GetVelocity() - ToVec3(m_simulationState.velocity));
+
+	// Step the simulation and remember the tick so it can be restored and re-simulated later.
+	m_simulationState = StepPlayerSimulation(m_simulationState, m_simulationInput);
+	m_simulationHistory.Record(++m_simulationTick, m_simulationInput, m_simulationState);
+
+	// Send the same velocity request the simulation applied to the character controller, nothing is requested while in air.
+	SPlayerSimulationVec2 movementRequest;
+	if (ComputePlayerMovementRequest(m_simulationInput, movementRequest))
 	{
-		velocity.y -= moveSpeed * frameTime;
+		m_pCharacterController->AddVelocity(Vec3(movementRequest.x, movementRequest.y, 0.f));
 	}
-	// update the character controller's velocity based off the velocity value as it changes.
-	m_pCharacterController->AddVelocity(velocity);
 }
 
 void CPlayerComponent::UpdateAnimation(float frameTime)
@@ -248,24 +253,8 @@ void CPlayerComponent::UpdateAnimation(float frameTime)
 	{
 		return;
 	}
-	// Dir is a direction vector 3 value, it will be the difference between the cursor's world position and 
-	// the player character' world position.
-	Vec3 dir = m_pCursorEntity->GetWorldPos() - m_pEntity->GetWorldPos();
-	// normalize the results.
-	dir = dir.Normalize();
-	// newRotation is a Quaternion which will be a rotation v direction
-	// which is based off the direction vector we created.
-	Quat newRotation = Quat::CreateRotationVDir(dir);
-	// ypr is Yaw Pit Rotation from Angles3. It will be created from the Camera Components'
-	// function to create angles YPR. The parameter is a 3x3 matrix based off our newRotation variable.
-	Ang3 ypr = CCamera::CreateAnglesYPR(Matrix33(newRotation));
-
-	// We only want to affect Z-axis rotation, zero pitch and roll
-	ypr.y = 0;
-	ypr.z = 0;
-
-	// Re-calculate the quaternion based on the corrected yaw
-	newRotation = Quat(CCamera::CreateOrientationYPR(ypr));
+	// The simulation already worked out the yaw towards the cursor, we only want to affect Z-axis rotation.
+	const Quat newRotation = Quat::CreateRotationZ(m_simulationState.yaw);
 
 	// If the character controller is walking
 	if (m_pCharacterController->IsWalking())
@@ -326,17 +315,14 @@ void CPlayerComponent::UpdateCursor(float frameTime)
 	// I would just be repeating it if documenting it out here. https://docs.cryengine.com//pages/viewpage.action?pageId=29797387
 	if (gEnv->pPhysicalWorld->RayWorldIntersection(vPos0, vDir * gEnv->p3DEngine->GetMaxViewDistance(), ent_all, rayFlags, &hit, 1))
 	{
-		m_cursorPositionInWorld = hit.pt;
+		m_simulationInput.cursorPosition = ToSimulationVec3(hit.pt);
 
 		if (m_pCursorEntity != nullptr)
 		{
 			m_pCursorEntity->SetPosRotScale(hit.pt, IDENTITY, m_pCursorEntity->GetScale());
 		}
 	}
-	else
-	{
-		m_cursorPositionInWorld = ZERO;
-	}
+	// If the ray misses we keep the last hit, just like the cursor entity stays where it was.
 }
 
 void CPlayerComponent::ResetPlayer()
@@ -346,6 +332,30 @@ void CPlayerComponent::ResetPlayer()
 	m_pCharacterController->Physicalize();
 	// Reset input now that the player respawned
 	m_inputFlags.Clear();
+	// Start the simulation over, earlier ticks no longer apply to the respawned player.
+	ResetSimulation();
+}
+
+void CPlayerComponent::ResetSimulation()
+{
+	m_simulationState.position = ToSimulationVec3(m_pEntity->GetWorldPos());
+	m_simulationState.velocity = { 0.f, 0.f, 0.f };
+	m_simulationState.yaw = m_pEntity->GetWorldAngles().z;
+	m_simulationTick = 0;
+	m_simulationHistory.Clear();
+}
+
+bool CPlayerComponent::ReconcileSimulation(uint32 tick, const SPlayerSimulationState& correctedState)
+{
+	SPlayerSimulationState resimulatedState;
+	if (!m_simulationHistory.RestoreAndResimulate(tick, correctedState, resimulatedState))
+		return false;
+
+	m_simulationState = resimulatedState;
+	// Move the entity to the corrected position and velocity, the next update continues from there.
+	m_pEntity->SetPosRotScale(ToVec3(resimulatedState.position), Quat::CreateRotationZ(resimulatedState.yaw), Vec3(1, 1, 1));
+	m_pCharacterController->SetVelocity(ToVec3(resimulatedState.velocity));
+	return true;
 }
 
 void CPlayerComponent::HandleInputFlagChange(const CEnumFlags<EInputFlag> flags, const CEnumFlags<EActionActivationMode> activationMode, const EInputFlagType type)
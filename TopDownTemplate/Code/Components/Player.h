@@ -12,6 +12,8 @@
 #include <DefaultComponents/Input/InputComponent.h>
 #include <DefaultComponents/Audio/ListenerComponent.h>
 
+#include "PlayerSimulation.h"
+
 ////////////////////////////////////////////////////////
 // Represents a player participating in gameplay
 ////////////////////////////////////////////////////////
@@ -27,13 +29,15 @@ class CPlayerComponent final : public IEntityComponent
 	// Creating an InputFlag for handling movement
 	enum class EInputFlag : uint8
 	{
-		// Note we are bit shifting to the left here.
-		// Move left's value is 1U and we are shifting 1 left which points to 0 which makes the value 10.
-		MoveLeft = 1 << 0,
-		MoveRight = 1 << 1,
-		MoveForward = 1 << 2,
-		MoveBack = 1 << 3
+		// The values match EPlayerSimulationMoveFlag so the flags can be handed to the simulation as they are.
+		MoveLeft = static_cast<uint8>(EPlayerSimulationMoveFlag::Left),
+		MoveRight = static_cast<uint8>(EPlayerSimulationMoveFlag::Right),
+		MoveForward = static_cast<uint8>(EPlayerSimulationMoveFlag::Forward),
+		MoveBack = static_cast<uint8>(EPlayerSimulationMoveFlag::Back)
 	};
+
+	// Number of ticks we keep around for restoring and re-simulating, must be a power of two.
+	static constexpr uint32 SimulationHistorySize = 64;
 // The below functions are public and are engine defined.
 public:
 	// Constructor for CPlayerComponent is the default constructor provided by Crytek.
@@ -53,6 +57,14 @@ public:
 	{
 		desc.SetGUID("{63F4C0C6-32AF-4ACB-8FB0-57D45DD14725}"_cry_guid);
 	}
+
+	// Replaces the simulated state of an earlier tick with a corrected one and re-simulates up to the current tick.
+	// Returns false if the tick is too old to still be in the history.
+	bool ReconcileSimulation(uint32 tick, const SPlayerSimulationState& correctedState);
+	// The tick that was simulated most recently.
+	uint32 GetSimulationTick() const { return m_simulationTick; }
+	// The simulated state after the most recent tick.
+	const SPlayerSimulationState& GetSimulationState() const { return m_simulationState; }
 	
 	// The below functions are private and are self defined.
 protected:
@@ -70,6 +82,8 @@ protected:
 	void InitializePlayer();
 	// We need to be able to reset the position, animation and input flags which will be handled here.
 	void ResetPlayer();
+	// We need to start the simulation over from where the entity currently is, clearing the recorded ticks.
+	void ResetSimulation();
 	// We need a function to actually handle our input flag changes. Will be done here.
 	void HandleInputFlagChange(CEnumFlags<EInputFlag> flags, CEnumFlags<EActionActivationMode> activationMode, EInputFlagType type = EInputFlagType::Hold);
 // The below properties are private..
@@ -92,8 +106,14 @@ protected:
 	CEnumFlags<EInputFlag> m_inputFlags;
 	// Definining of our Vector2 which will store the mouse rotation.
 	Vec2 m_mouseDeltaRotation;
-	// Definining of our Vector2 which will store the mouse position and initializing it to zero vector position.
-	Vec3 m_cursorPositionInWorld = ZERO;
+	// Definining of the simulation input for the next tick, the cursor position is stored here as it changes.
+	SPlayerSimulationInput m_simulationInput = {};
 	// Definining of our mouse cursor and initializing it as a null pointer.
 	IEntity* m_pCursorEntity = nullptr;
+	// The simulated movement and facing state after the most recent tick.
+	SPlayerSimulationState m_simulationState = {};
+	// Counter for the simulation ticks, incremented on each update.
+	uint32 m_simulationTick = 0;
+	// Ring of the most recent ticks, used to restore and re-simulate.
+	CPlayerSimulationHistory<SimulationHistorySize> m_simulationHistory;
 };
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+////////////////////////////////////////////////////////
+// Deterministic player movement and facing simulation, kept separate from the engine components
+// so that it can be snapshotted, restored and re-simulated for prediction and reconciliation.
+// This header only depends on the standard library so it can be tested without the engine.
+////////////////////////////////////////////////////////
+
+// Small vector types for the simulation, the component converts them to and from Vec2 / Vec3.
+struct SPlayerSimulationVec2
+{
+	float x, y;
+};
+
+struct SPlayerSimulationVec3
+{
+	float x, y, z;
+};
+
+// Movement bits stored in SPlayerSimulationInput::moveFlags, CPlayerComponent's EInputFlag uses the same values.
+enum class EPlayerSimulationMoveFlag : uint8_t
+{
+	// Note we are bit shifting to the left here, so every direction gets its own bit.
+	// Left is 1 shifted by 0 (binary 0001), right is 1 shifted by 1 (binary 0010) and so on.
+	Left = 1 << 0,
+	Right = 1 << 1,
+	Forward = 1 << 2,
+	Back = 1 << 3
+};
+
+// Everything a single simulation tick consumes.
+struct SPlayerSimulationInput
+{
+	// The frame time this tick was simulated with.
+	float frameTime;
+	// World position of the cursor the player is facing towards.
+	SPlayerSimulationVec3 cursorPosition;
+	// Where physics actually put the player at the start of this tick, relative to the position the simulation predicted.
+	// Collisions, slopes, friction and gravity are all handled by the character controller and show up here.
+	SPlayerSimulationVec3 positionCorrection;
+	// Same as positionCorrection, for the velocity physics resolved.
+	SPlayerSimulationVec3 velocityCorrection;
+	// Combination of EPlayerSimulationMoveFlag bits.
+	uint8_t moveFlags;
+	// Non-zero if the character controller was on the ground.
+	uint8_t isOnGround;
+};
+
+// The player's simulated state after a tick.
+struct SPlayerSimulationState
+{
+	// Predicted position and velocity for the start of the next tick.
+	SPlayerSimulationVec3 position;
+	SPlayerSimulationVec3 velocity;
+	// Rotation around the Z-axis, the player only ever turns on the ground plane.
+	float yaw;
+};
+
+// One entry of the simulation history, the input of a tick together with the state it produced.
+struct SPlayerSimulationSnapshot
+{
+	uint32_t tick;
+	SPlayerSimulationInput input;
+	SPlayerSimulationState state;
+};
+
+// Snapshots are copied around in bulk when restoring and re-simulating, make sure that stays a plain memory copy.
+static_assert(std::is_trivially_copyable<SPlayerSimulationInput>::value, "SPlayerSimulationInput must be trivially copyable");
+static_assert(std::is_trivially_copyable<SPlayerSimulationState>::value, "SPlayerSimulationState must be trivially copyable");
+static_assert(std::is_trivially_copyable<SPlayerSimulationSnapshot>::value, "SPlayerSimulationSnapshot must be trivially copyable");
+
+inline bool HasPlayerSimulationMoveFlag(uint8_t moveFlags, EPlayerSimulationMoveFlag flag)
+{
+	return (moveFlags & static_cast<uint8_t>(flag)) != 0;
+}
+
+// Works out the velocity the movement input requests from the character controller during one tick.
+// Returns false if no request should be made at all.
+inline bool ComputePlayerMovementRequest(const SPlayerSimulationInput& input, SPlayerSimulationVec2& outVelocity)
+{
+	// Don't handle input if we are in air
+	if (!input.isOnGround)
+		return false;
+
+	// 20.5 is a smooth movement speed.
+	const float moveSpeed = 20.5f;
+	const float step = moveSpeed * input.frameTime;
+
+	outVelocity = { 0.f, 0.f };
+	if (HasPlayerSimulationMoveFlag(input.moveFlags, EPlayerSimulationMoveFlag::Left))
+	{
+		outVelocity.x -= step;
+	}
+	if (HasPlayerSimulationMoveFlag(input.moveFlags, EPlayerSimulationMoveFlag::Right))
+	{
+		outVelocity.x += step;
+	}
+	if (HasPlayerSimulationMoveFlag(input.moveFlags, EPlayerSimulationMoveFlag::Forward))
+	{
+		outVelocity.y += step;
+	}
+	if (HasPlayerSimulationMoveFlag(input.moveFlags, EPlayerSimulationMoveFlag::Back))
+	{
+		outVelocity.y -= step;
+	}
+	return true;
+}
+
+// Advances the state by one tick. This has no side effects, the same state and input always produce the same result.
+// The character controller stays in charge of the actual movement, the step only mirrors the velocity request
+// the component sends it and predicts where that takes the player. What physics did differently is fed back in
+// through the input corrections, so the prediction never drifts from the real player.
+inline SPlayerSimulationState StepPlayerSimulation(const SPlayerSimulationState& state, const SPlayerSimulationInput& input)
+{
+	SPlayerSimulationState next = state;
+
+	// Start the tick from where physics actually put the player.
+	next.position.x += input.positionCorrection.x;
+	next.position.y += input.positionCorrection.y;
+	next.position.z += input.positionCorrection.z;
+	next.velocity.x += input.velocityCorrection.x;
+	next.velocity.y += input.velocityCorrection.y;
+	next.velocity.z += input.velocityCorrection.z;
+
+	// Face the cursor from the player's position, the default forward direction is along the Y-axis.
+	// Keep the previous facing when the cursor is right on top of the player since the direction is undefined.
+	const float dirX = input.cursorPosition.x - next.position.x;
+	const float dirY = input.cursorPosition.y - next.position.y;
+	if (dirX * dirX + dirY * dirY > 1e-8f)
+	{
+		next.yaw = std::atan2(-dirX, dirY);
+	}
+
+	SPlayerSimulationVec2 movementRequest;
+	if (ComputePlayerMovementRequest(input, movementRequest))
+	{
+		next.velocity.x += movementRequest.x;
+		next.velocity.y += movementRequest.y;
+	}
+
+	next.position.x += next.velocity.x * input.frameTime;
+	next.position.y += next.velocity.y * input.frameTime;
+	next.position.z += next.velocity.z * input.frameTime;
+	return next;
+}
+
+////////////////////////////////////////////////////////
+// Fixed-size ring of per-tick snapshots, used to restore an earlier tick and re-simulate up to the present
+////////////////////////////////////////////////////////
+template<uint32_t Size>
+class CPlayerSimulationHistory
+{
+	// Power of two sizes let us map ticks to slots with a mask instead of a division.
+	static_assert(Size > 0 && (Size & (Size - 1)) == 0, "CPlayerSimulationHistory size must be a power of two");
+
+public:
+	// Forgets all recorded ticks.
+	void Clear()
+	{
+		m_count = 0;
+	}
+
+	// Stores the input and resulting state for a tick, overwriting the oldest entry when the ring is full.
+	// Re-simulating needs every tick in between, so a tick that doesn't follow the newest one starts the history over.
+	void Record(uint32_t tick, const SPlayerSimulationInput& input, const SPlayerSimulationState& state)
+	{
+		if (m_count != 0 && tick != m_newestTick + 1)
+		{
+			Clear();
+		}
+
+		SPlayerSimulationSnapshot& snapshot = m_snapshots[tick & (Size - 1)];
+		snapshot.tick = tick;
+		snapshot.input = input;
+		snapshot.state = state;
+
+		m_newestTick = tick;
+		if (m_count < Size)
+		{
+			++m_count;
+		}
+	}
+
+	// Returns the snapshot for a tick, or nullptr if it was never recorded or has already been overwritten.
+	const SPlayerSimulationSnapshot* Find(uint32_t tick) const
+	{
+		if (m_newestTick - tick >= m_count)
+			return nullptr;
+
+		return &m_snapshots[tick & (Size - 1)];
+	}
+
+	// Replaces the state of a recorded tick with a corrected one, then re-runs every newer tick with its stored input.
+	// The history is updated in place and the re-simulated state of the newest tick is returned through outState.
+	// Returns false if the tick is no longer in the history.
+	bool RestoreAndResimulate(uint32_t tick, const SPlayerSimulationState& correctedState, SPlayerSimulationState& outState)
+	{
+		if (Find(tick) == nullptr)
+			return false;
+
+		SPlayerSimulationState state = correctedState;
+		m_snapshots[tick & (Size - 1)].state = state;
+
+		for (uint32_t replayTick = tick; replayTick != m_newestTick;)
+		{
+			SPlayerSimulationSnapshot& snapshot = m_snapshots[++replayTick & (Size - 1)];
+			state = StepPlayerSimulation(state, snapshot.input);
+			snapshot.state = state;
+		}
+
+		outState = state;
+		return true;
+	}
+
+	uint32_t GetNewestTick() const { return m_newestTick; }
+	uint32_t GetCount() const { return m_count; }
+
+protected:
+	SPlayerSimulationSnapshot m_snapshots[Size];
+	uint32_t m_newestTick = 0;
+	uint32_t m_count = 0;
+};
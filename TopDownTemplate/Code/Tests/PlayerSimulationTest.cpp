@@ -0,0 +1,243 @@
+#include "Components/PlayerSimulation.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+////////////////////////////////////////////////////////
+// Checks that the player simulation replays bit-exactly and measures how long restoring and re-simulating takes
+////////////////////////////////////////////////////////
+namespace
+{
+	// Keep the history the same size as CPlayerComponent uses.
+	const uint32_t HistorySize = 64;
+	const uint32_t TickCount = 200;
+	// How far back a reconciliation rolls, the request asks for at least 10 ticks.
+	const uint32_t ResimulatedTicks = 12;
+	const int TimingIterations = 100000;
+	// Hash of the final state after the fixed input script, see HashState.
+	const uint32_t ExpectedFinalStateHash = 0xE1D00918u;
+
+	int g_failures = 0;
+
+	void Check(bool condition, const char* szDescription)
+	{
+		if (!condition)
+		{
+			std::printf("FAILED: %s\n", szDescription);
+			++g_failures;
+		}
+	}
+
+	bool StatesEqual(const SPlayerSimulationState& a, const SPlayerSimulationState& b)
+	{
+		return std::memcmp(&a, &b, sizeof(SPlayerSimulationState)) == 0;
+	}
+
+	// Produces varied but reproducible input, with jumps and changing frame times thrown in.
+	SPlayerSimulationInput MakeInput(uint32_t tick)
+	{
+		SPlayerSimulationInput input = {};
+		input.frameTime = 1.f / 60.f + static_cast<float>(tick % 7) * 0.001f;
+		input.cursorPosition = { static_cast<float>(tick % 13) - 6.f, static_cast<float>(tick % 11) - 5.f, 0.f };
+		// Hold right for the first second so the player runs into the wall, then cycle through the other combinations.
+		input.moveFlags = tick <= 60 ? static_cast<uint8_t>(EPlayerSimulationMoveFlag::Right) : static_cast<uint8_t>((tick / 5) % 16);
+		input.isOnGround = (tick % 40) < 30 ? 1 : 0;
+		return input;
+	}
+
+	// Stand-in for the character controller, with its own friction and gravity and a wall the simulation knows nothing about.
+	struct SFakePhysics
+	{
+		SPlayerSimulationVec3 position;
+		SPlayerSimulationVec3 velocity;
+		uint32_t wallContacts;
+
+		void Update(const SPlayerSimulationInput& input)
+		{
+			SPlayerSimulationVec2 movementRequest;
+			if (ComputePlayerMovementRequest(input, movementRequest))
+			{
+				velocity.x += movementRequest.x;
+				velocity.y += movementRequest.y;
+				velocity.x *= 0.9f;
+				velocity.y *= 0.9f;
+				velocity.z = 0.f;
+			}
+			else
+			{
+				velocity.z -= 13.f * input.frameTime;
+			}
+
+			position.x += velocity.x * input.frameTime;
+			position.y += velocity.y * input.frameTime;
+			position.z += velocity.z * input.frameTime;
+
+			const float wallX = 0.5f;
+			if (position.x > wallX)
+			{
+				position.x = wallX;
+				velocity.x = 0.f;
+				++wallContacts;
+			}
+		}
+	};
+
+	// Runs the simulation from scratch the way CPlayerComponent does, feeding back what the fake physics did each tick.
+	// Also checks that the player faces the cursor from where physics really put it, not from a position that drifted away.
+	SPlayerSimulationState Simulate(CPlayerSimulationHistory<HistorySize>& history)
+	{
+		SPlayerSimulationState state = {};
+		SFakePhysics physics = {};
+		float maxFacingError = 0.f;
+
+		for (uint32_t tick = 1; tick <= TickCount; ++tick)
+		{
+			SPlayerSimulationInput input = MakeInput(tick);
+			input.positionCorrection = { physics.position.x - state.position.x, physics.position.y - state.position.y, physics.position.z - state.position.z };
+			input.velocityCorrection = { physics.velocity.x - state.velocity.x, physics.velocity.y - state.velocity.y, physics.velocity.z - state.velocity.z };
+
+			state = StepPlayerSimulation(state, input);
+			history.Record(tick, input, state);
+
+			const float expectedYaw = std::atan2(-(input.cursorPosition.x - physics.position.x), input.cursorPosition.y - physics.position.y);
+			maxFacingError = std::fmax(maxFacingError, std::fabs(state.yaw - expectedYaw));
+
+			physics.Update(input);
+		}
+
+		Check(physics.wallContacts > 0, "the player runs into the wall");
+		Check(maxFacingError < 1e-4f, "the player faces the cursor from the physics position");
+		return state;
+	}
+
+	const SPlayerSimulationSnapshot* FindChecked(const CPlayerSimulationHistory<HistorySize>& history, uint32_t tick)
+	{
+		const SPlayerSimulationSnapshot* pSnapshot = history.Find(tick);
+		Check(pSnapshot != nullptr, "an expected tick is in the history");
+		return pSnapshot;
+	}
+
+	bool HistoriesEqual(const CPlayerSimulationHistory<HistorySize>& a, const CPlayerSimulationHistory<HistorySize>& b)
+	{
+		for (uint32_t tick = TickCount - HistorySize + 1; tick <= TickCount; ++tick)
+		{
+			const SPlayerSimulationSnapshot* pA = FindChecked(a, tick);
+			const SPlayerSimulationSnapshot* pB = FindChecked(b, tick);
+			if (pA == nullptr || pB == nullptr || !StatesEqual(pA->state, pB->state))
+				return false;
+		}
+		return true;
+	}
+
+	// FNV-1a over the raw bytes of a state.
+	uint32_t HashState(const SPlayerSimulationState& state)
+	{
+		const unsigned char* pBytes = reinterpret_cast<const unsigned char*>(&state);
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < sizeof(SPlayerSimulationState); ++i)
+		{
+			hash = (hash ^ pBytes[i]) * 16777619u;
+		}
+		return hash;
+	}
+}
+
+int main()
+{
+	CPlayerSimulationHistory<HistorySize> history;
+	const SPlayerSimulationState finalState = Simulate(history);
+
+	// Running the same inputs twice has to give the same states.
+	{
+		CPlayerSimulationHistory<HistorySize> secondRun;
+		Check(StatesEqual(finalState, Simulate(secondRun)), "two runs end in the same state");
+		Check(HistoriesEqual(history, secondRun), "two runs record the same states");
+	}
+
+	// Only the most recent ticks are kept.
+	Check(history.Find(TickCount) != nullptr, "newest tick is in the history");
+	Check(history.Find(TickCount - HistorySize + 1) != nullptr, "oldest kept tick is in the history");
+	Check(history.Find(TickCount - HistorySize) == nullptr, "overwritten tick is not in the history");
+	Check(history.Find(TickCount + 1) == nullptr, "future tick is not in the history");
+
+	// The final state of the fixed input script is pinned, so behaviour changes between builds or runs are caught too.
+	// Update ExpectedFinalStateHash when the simulation is changed on purpose.
+	{
+		const uint32_t finalStateHash = HashState(finalState);
+		std::printf("Final state hash: 0x%08X\n", finalStateHash);
+		Check(finalStateHash == ExpectedFinalStateHash, "the final state matches the recorded golden hash");
+	}
+
+	const uint32_t restoreTick = TickCount - ResimulatedTicks;
+	const SPlayerSimulationSnapshot* pRestoreSnapshot = FindChecked(history, restoreTick);
+	if (pRestoreSnapshot == nullptr)
+	{
+		std::printf("%d check(s) failed\n", g_failures);
+		return 1;
+	}
+
+	// Restoring a tick with its own recorded state has to reproduce every newer recorded state exactly.
+	{
+		CPlayerSimulationHistory<HistorySize> replayed = history;
+		SPlayerSimulationState resimulatedState;
+		Check(replayed.RestoreAndResimulate(restoreTick, pRestoreSnapshot->state, resimulatedState), "restoring a kept tick succeeds");
+		Check(StatesEqual(resimulatedState, finalState), "replay with an unchanged state ends in the recorded state");
+		Check(HistoriesEqual(replayed, history), "replay with an unchanged state reproduces the recorded states");
+	}
+
+	// A correction changes the outcome, and replaying the same correction again gives the same result.
+	{
+		SPlayerSimulationState correctedState = pRestoreSnapshot->state;
+		correctedState.position.x += 1.f;
+		correctedState.velocity.y -= 2.f;
+
+		CPlayerSimulationHistory<HistorySize> firstReplay = history;
+		CPlayerSimulationHistory<HistorySize> secondReplay = history;
+		SPlayerSimulationState firstState, secondState;
+		firstReplay.RestoreAndResimulate(restoreTick, correctedState, firstState);
+		secondReplay.RestoreAndResimulate(restoreTick, correctedState, secondState);
+		Check(!StatesEqual(firstState, finalState), "a correction changes the re-simulated state");
+		Check(StatesEqual(firstState, secondState), "replaying the same correction twice gives the same state");
+		Check(HistoriesEqual(firstReplay, secondReplay), "replaying the same correction twice records the same states");
+	}
+
+	// A tick that doesn't follow the newest one starts the history over, so stale inputs are never replayed.
+	{
+		CPlayerSimulationHistory<HistorySize> gapped = history;
+		gapped.Record(TickCount + 5, MakeInput(TickCount + 5), finalState);
+		Check(gapped.GetCount() == 1, "a gap starts the history over");
+		Check(gapped.Find(TickCount) == nullptr, "ticks before a gap are forgotten");
+		SPlayerSimulationState unused;
+		Check(!gapped.RestoreAndResimulate(restoreTick, finalState, unused), "restoring a tick before a gap fails");
+	}
+
+	// Time restoring and re-simulating, the history is reset to the recording each time so every iteration does the same work.
+	{
+		CPlayerSimulationHistory<HistorySize> replayed = history;
+		const SPlayerSimulationState restoreState = pRestoreSnapshot->state;
+		SPlayerSimulationState resimulatedState = {};
+		float checksum = 0.f;
+
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < TimingIterations; ++i)
+		{
+			replayed.RestoreAndResimulate(restoreTick, restoreState, resimulatedState);
+			checksum += resimulatedState.position.x;
+		}
+		const auto end = std::chrono::steady_clock::now();
+
+		const double microseconds = std::chrono::duration<double, std::micro>(end - start).count() / TimingIterations;
+		std::printf("Restore and re-simulate %u ticks: %.3f us (checksum %f)\n", ResimulatedTicks, microseconds, checksum);
+		Check(StatesEqual(resimulatedState, finalState), "timed replays end in the recorded state");
+	}
+
+	if (g_failures != 0)
+	{
+		std::printf("%d check(s) failed\n", g_failures);
+		return 1;
+	}
+	std::printf("All player simulation checks passed\n");
+	return 0;
+}